@@ -3,18 +3,24 @@
 #include <boost/date_time/gregorian/gregorian.hpp>
 #include <boost/fusion/include/adapt_struct.hpp>
 #include <boost/fusion/include/std_pair.hpp>
-#include <boost/lexical_cast.hpp>
 #include <boost/spirit/include/qi.hpp>
 #include <boost/spirit/include/phoenix.hpp>
 
 #include <cmath>
-#include <sstream>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <memory_resource>
+#include <new>
 #include <stdexcept>
+#include <string>
+#include <string_view>
 
 #include "cfws_skipper.h"
 #include "date_time.h"
 
 using namespace boost::spirit::qi;
+namespace phx = boost::phoenix;
 
 BOOST_FUSION_ADAPT_STRUCT(::date_time::date,
     (::date_time::days, week_day)
@@ -33,57 +39,70 @@ BOOST_FUSION_ADAPT_STRUCT(::date_time::time,
 namespace
 {
 
-void validate_min_max(char const* name,
+typedef ::date_time::diagnostic* diagnostic_ptr;
+
+// Records the first reason a parse failed and returns false, so it can be
+// assigned to _pass.
+bool reject(diagnostic_ptr error, char const* format, ...)
+{
+    if (error->text[0] == '\0') {
+        std::va_list args;
+        va_start(args, format);
+        std::vsnprintf(error->text, sizeof(error->text), format, args);
+        va_end(args);
+    }
+    return false;
+}
+
+bool validate_min_max(diagnostic_ptr error, char const* name,
     unsigned value, unsigned min_value, unsigned max_value)
 {
     if (value < min_value || value > max_value) {
-        std::ostringstream message;
-        message << name << ' ' << value << " out of range "
-            << min_value << '-' << max_value;
-        throw std::domain_error(message.str());
+        return reject(error, "%s %u out of range %u-%u",
+            name, value, min_value, max_value);
     }
+    return true;
 }
 
-void validate_day(unsigned day)
+bool validate_day(unsigned day, diagnostic_ptr error)
 {
-    validate_min_max("day", day, 1U, 31U);
+    return validate_min_max(error, "day", day, 1U, 31U);
 }
 
-void validate_year(unsigned year)
+bool validate_year(unsigned year, diagnostic_ptr error)
 {
-    validate_min_max("year", year, 1900U, 9999U);
+    return validate_min_max(error, "year", year, 1900U, 9999U);
 }
 
-void validate_date(const ::date_time::date& date)
+bool validate_date(const ::date_time::date& date, diagnostic_ptr error)
 {
-    try {
-        boost::gregorian::date check(date.year, date.month, date.day);
-        if (date.week_day == date_time::Unspecified) {
-            return;
-        }
-        if (static_cast<unsigned>(date.week_day) != check.day_of_week().as_number()) {
-            throw std::domain_error("day name doesn't match day of date");
-        }
-    } catch (const std::out_of_range&) {
-        throw std::domain_error("day "
-            + boost::lexical_cast<std::string>(date.day)
-            + " invalid for month");
+    if (date.day > boost::gregorian::gregorian_calendar::end_of_month_day(
+            date.year, date.month)) {
+        return reject(error, "day %u invalid for month", date.day);
     }
+    if (date.week_day == date_time::Unspecified) {
+        return true;
+    }
+    boost::gregorian::date check(date.year, date.month, date.day);
+    if (static_cast<unsigned>(date.week_day) != check.day_of_week().as_number()) {
+        return reject(error, "day name doesn't match day of date");
+    }
+    return true;
 }
 
-void validate_hour(unsigned hour)
+bool validate_hour(unsigned hour, diagnostic_ptr error)
 {
-    validate_min_max("hour", hour, 0U, 23U);
+    return validate_min_max(error, "hour", hour, 0U, 23U);
 }
 
-void validate_minute(unsigned minute)
+bool validate_minute(unsigned minute, diagnostic_ptr error)
 {
-    validate_min_max("minute", minute, 0U, 59U);
+    return validate_min_max(error, "minute", minute, 0U, 59U);
 }
 
-void validate_second(unsigned second)
+bool validate_second(unsigned second, diagnostic_ptr error)
 {
-    validate_min_max("second", second, 0U, 60U);
+    return validate_min_max(error, "second", second, 0U, 60U);
 }
 
 bool last_day_of_June_or_December(::date_time::date const& date)
@@ -92,23 +111,38 @@ bool last_day_of_June_or_December(::date_time::date const& date)
         || (date.month == ::date_time::December && date.day == 31);
 }
 
-void validate_date_time(::date_time::moment const& moment)
+bool validate_date_time(::date_time::moment const& moment,
+    diagnostic_ptr error)
 {
     if (moment.second.second == 60
         && !(last_day_of_June_or_December(moment.first)
             && moment.second.hour == 23
             && moment.second.minute == 59)) {
-        throw std::domain_error(
+        return reject(error,
             "leap second only allowed on last day of June or December");
     }
+    return true;
+}
+
+template <typename Iter>
+bool find_time_zone(::date_time::time_zone_table const* zones, bool strict,
+    boost::iterator_range<Iter> const& name, int& offset)
+{
+    auto const zone = zones->find(std::string_view{&*name.begin(),
+        static_cast<std::size_t>(name.size())});
+    if (!zone || (strict && !zone->strict)) {
+        return false;
+    }
+    offset = zone->offset;
+    return true;
 }
 
-void validate_time_zone_offset(int offset)
+bool validate_time_zone_offset(int offset, diagnostic_ptr error)
 {
-    validate_min_max("timezone offset hour",
-        static_cast<unsigned>(std::abs(offset) / 100), 0U, 23U);
-    validate_min_max("timezone offset minute",
-        static_cast<unsigned>(offset % 100), 0U, 59U);
+    return validate_min_max(error, "timezone offset hour",
+            static_cast<unsigned>(std::abs(offset) / 100), 0U, 23U)
+        && validate_min_max(error, "timezone offset minute",
+            static_cast<unsigned>(offset % 100), 0U, 59U);
 }
 
 template <typename Iter>
@@ -116,7 +150,18 @@ struct date_time_grammar : grammar<Iter, date_time::moment(), cfws::skipper<Iter
 {
     typedef cfws::skipper<Iter> skipper;
 
-    date_time_grammar() : date_time_grammar::base_type{start}
+    // Semantic action that fails the parse when a validator rejects the
+    // attribute, recording why in the current diagnostic.
+    template <typename Validator>
+    auto check(Validator validator) const
+    {
+        return _pass = phx::bind(validator, _1, phx::cref(error));
+    }
+
+    date_time_grammar(::date_time::strictness mode,
+        ::date_time::time_zone_table const& zones)
+        : date_time_grammar::base_type{start},
+        error{nullptr}
     {
         uint_parser<unsigned, 10, 1, 2> digit_1_2;
         uint_parser<unsigned, 10, 2, 2> digit_2;
@@ -143,34 +188,26 @@ struct date_time_grammar : grammar<Iter, date_time::moment(), cfws::skipper<Iter
             ("Sat", date_time::Saturday)
             ("Sun", date_time::Sunday);
         week_day = (day_names >> ',') | attr(date_time::Unspecified);
-        day_number %= digit_1_2[&validate_day];
+        day_number %= digit_1_2[check(&validate_day)];
         year_2 %= digit_2[_val += if_else(_1 < 50U, 2000U, 1900U)];
         year_3 %= digit_3[_val += 1900];
-        year_number %= (digit_4 | year_3 | year_2)[&validate_year];
+        year_number %= (digit_4 | year_3 | year_2)[check(&validate_year)];
         date_part = week_day >> day_number >> month_names >> year_number;
 
         seconds = (':' >> digit_2) | attr(0);
         int_parser<int, 10, 4, 4> time_zone_offset;
-        time_zone_names.add("UT", +000)("GMT", +000)
-            ("EST", -500)("EDT", -400)
-            ("CST", -600)("CDT", -500)
-            ("MST", -700)("MDT", -600)
-            ("PST", -800)("PDT", -700)
-            ("A", -100)("B", - 200)("C", - 300)("D", -400)
-            ("E", -500)("F", - 600)("G", - 700)("H", -800)
-            ("I", -900)("K", -1000)("L", -1100)("M", -1200)
-            ("N", +100)("O", + 200)("P", + 300)("Q", +400)
-            ("R", +500)("S", + 600)("T", + 700)("U", +800)
-            ("V", +900)("W", +1000)("X", +1100)("Y", +1200)
-            ("Z", +000);
-        time_zone %= time_zone_names
-            | (&(lit('+') | '-') >> time_zone_offset)[&validate_time_zone_offset];
-        time_part %= digit_2[&validate_hour]
-            >> lit(':') >> digit_2[&validate_minute]
-            >> seconds[&validate_second]
+        time_zone_name = raw[+ascii::alpha][_pass = phx::bind(
+            &find_time_zone<Iter>, &zones, mode == date_time::Strict, _1, _val)];
+        time_zone %= time_zone_name
+            | (&(lit('+') | '-') >> time_zone_offset)
+                [check(&validate_time_zone_offset)];
+        time_part %= digit_2[check(&validate_hour)]
+            >> lit(':') >> digit_2[check(&validate_minute)]
+            >> seconds[check(&validate_second)]
             >> time_zone;
-        date_time %= date_part[&validate_date] >> time_part;
-        start %= date_time[&validate_date_time];
+        valid_date %= date_part[check(&validate_date)];
+        date_time %= valid_date >> time_part;
+        start %= date_time[check(&validate_date_time)];
     };
 
     symbols<char const, date_time::days> day_names;
@@ -181,12 +218,14 @@ struct date_time_grammar : grammar<Iter, date_time::moment(), cfws::skipper<Iter
     rule<Iter, unsigned()> year_3;
     rule<Iter, unsigned()> year_2;
     rule<Iter, date_time::date(), skipper> date_part;
+    rule<Iter, date_time::date(), skipper> valid_date;
     rule<Iter, unsigned(), skipper> seconds;
-    symbols<char const, int> time_zone_names;
+    rule<Iter, int()> time_zone_name;
     rule<Iter, int()> time_zone;
     rule<Iter, date_time::time(), skipper> time_part;
     rule<Iter, date_time::moment(), skipper> date_time;
     rule<Iter, date_time::moment(), skipper> start;
+    diagnostic_ptr error;
 };
 
 }
@@ -194,19 +233,134 @@ struct date_time_grammar : grammar<Iter, date_time::moment(), cfws::skipper<Iter
 namespace date_time
 {
 
-moment parse(std::string const& text)
+struct parser::impl
 {
-    moment result{};
-    std::string::const_iterator start{text.begin()};
-    if (phrase_parse(start, text.end(),
-            date_time_grammar<std::string::const_iterator>{},
-            cfws::skipper<std::string::const_iterator>{}, result)
-        && start == text.end())
+    typedef char const* iterator;
+
+    impl(strictness mode, time_zone_table const& zones)
+        : grammar{mode, zones}
+    {}
+
+    date_time_grammar<iterator> grammar;
+    cfws::skipper<iterator> skipper;
+};
+
+parser::parser(std::pmr::memory_resource* resource, strictness mode,
+    time_zone_table const& zones)
+    : resource_{resource},
+    impl_{std::pmr::polymorphic_allocator<impl>{resource}.allocate(1)}
+{
+    try {
+        ::new (static_cast<void*>(impl_)) impl{mode, zones};
+    } catch (...) {
+        std::pmr::polymorphic_allocator<impl>{resource_}.deallocate(impl_, 1);
+        throw;
+    }
+}
+
+parser::~parser()
+{
+    impl_->~impl();
+    std::pmr::polymorphic_allocator<impl>{resource_}.deallocate(impl_, 1);
+}
+
+bool parser::try_parse(std::string_view text, moment& result,
+    diagnostic& error) const
+{
+    error.text[0] = '\0';
+    impl_->grammar.error = &error;
+    result = moment{};
+    impl::iterator start{text.data()};
+    impl::iterator const end{text.data() + text.size()};
+    if (phrase_parse(start, end, impl_->grammar, impl_->skipper, result)
+        && start == end)
     {
-        return result;
+        return true;
+    }
+
+    return reject(&error, "invalid date time");
+}
+
+moment parser::parse(std::string_view text) const
+{
+    moment result;
+    diagnostic error;
+    if (!try_parse(text, result, error)) {
+        throw std::domain_error(error.text);
+    }
+    return result;
+}
+
+sequential_parser::sequential_parser(std::pmr::memory_resource* resource,
+    strictness mode, time_zone_table const& zones)
+    : parser_{resource, mode, zones},
+    prefix_{resource},
+    date_{},
+    parses_{0},
+    reuses_{0}
+{}
+
+bool sequential_parser::try_parse(std::string_view text, moment& result,
+    diagnostic& error)
+{
+    ++parses_;
+    auto& grammar = parser_.impl_->grammar;
+    auto const& skipper = parser_.impl_->skipper;
+    error.text[0] = '\0';
+    grammar.error = &error;
+    result = moment{};
+    parser::impl::iterator start{text.data()};
+    parser::impl::iterator const end{text.data() + text.size()};
+    if (!prefix_.empty()
+        && text.substr(0, prefix_.size()) == std::string_view{prefix_})
+    {
+        ++reuses_;
+        result.first = date_;
+        start += prefix_.size() - 1;
+    } else {
+        prefix_.clear();
+        if (!phrase_parse(start, end, grammar.valid_date, skipper,
+                skip_flag::dont_postskip, result.first))
+        {
+            return reject(&error, "invalid date time");
+        }
+        // The date rules may look one character past the date, so that
+        // character is part of the prefix that must match for reuse.
+        if (start != end) {
+            prefix_.assign(text.data(), start - text.data() + 1);
+            date_ = result.first;
+        }
     }
 
-    throw std::domain_error("invalid date time");
+    if (phrase_parse(start, end, grammar.time_part, skipper, result.second)
+        && validate_date_time(result, &error)
+        && start == end)
+    {
+        return true;
+    }
+
+    return reject(&error, "invalid date time");
+}
+
+moment sequential_parser::parse(std::string_view text)
+{
+    moment result;
+    diagnostic error;
+    if (!try_parse(text, result, error)) {
+        throw std::domain_error(error.text);
+    }
+    return result;
+}
+
+double sequential_parser::reuse_rate() const
+{
+    return parses_ == 0 ? 0.0 : static_cast<double>(reuses_) / parses_;
+}
+
+moment parse(std::string const& text)
+{
+    thread_local parser const instance;
+    return instance.parse(text);
 }
 
 }
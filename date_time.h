@@ -2,9 +2,14 @@
 #if !defined(DATE_TIME_H)
 #define DATE_TIME_H
 
+#include <cstddef>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <utility>
 
+#include "time_zone_table.h"
+
 namespace date_time
 {
 
@@ -54,6 +59,83 @@ struct time
 
 typedef std::pair<date, time> moment;
 
+// Why a parse failed; try_parse fills it in without allocating.
+struct diagnostic
+{
+    char text[96];
+};
+
+// Strict parsers accept only time zone names marked strict in their table.
+enum strictness
+{
+    Lenient,
+    Strict
+};
+
+// Reusable parser; the grammar is built once at construction and shared
+// by every call to parse.  Only the parser object holding the grammar is
+// allocated from the given memory resource; the grammar's rules and symbol
+// tables are built on the global heap.  After construction, try_parse does
+// no heap allocation, whether or not the text is valid; parse allocates
+// only for the exception it throws.  A parser may be used by one thread at
+// a time.
+class parser
+{
+public:
+    explicit parser(
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+        strictness mode = Lenient,
+        time_zone_table const& zones = time_zones());
+    // The parser keeps a reference to zones, so it must outlive the parser.
+    parser(std::pmr::memory_resource* resource, strictness mode,
+        time_zone_table&& zones) = delete;
+    ~parser();
+    parser(parser const&) = delete;
+    parser& operator=(parser const&) = delete;
+
+    moment parse(std::string_view text) const;
+    // Returns false and describes the problem in error instead of throwing.
+    bool try_parse(std::string_view text, moment& result,
+        diagnostic& error) const;
+
+private:
+    friend class sequential_parser;
+    struct impl;
+    std::pmr::memory_resource* resource_;
+    impl* impl_;
+};
+
+// Parser for streams where consecutive inputs usually share the same date,
+// such as time-ordered logs.  When an input begins with the same bytes as
+// the date of the previous input, the previously validated date is reused
+// and only the time and zone are parsed.  Results are the same as parser
+// for inputs in any order.
+class sequential_parser
+{
+public:
+    explicit sequential_parser(
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+        strictness mode = Lenient,
+        time_zone_table const& zones = time_zones());
+    sequential_parser(std::pmr::memory_resource* resource, strictness mode,
+        time_zone_table&& zones) = delete;
+
+    moment parse(std::string_view text);
+    bool try_parse(std::string_view text, moment& result, diagnostic& error);
+
+    std::size_t parses() const { return parses_; }
+    std::size_t reuses() const { return reuses_; }
+    double reuse_rate() const;
+
+private:
+    parser parser_;
+    std::pmr::string prefix_;
+    date date_;
+    std::size_t parses_;
+    std::size_t reuses_;
+};
+
+// Parses with a parser owned by the calling thread.
 moment parse(std::string const& text);
 
 }
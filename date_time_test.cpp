@@ -4,6 +4,40 @@
 #include <boost/test/unit_test.hpp>
 #include "date_time.h"
 
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+namespace
+{
+
+std::size_t global_allocations = 0;
+
+}
+
+// Counts global heap allocations so tests can verify a parse makes none.
+void* operator new(std::size_t size)
+{
+    ++global_allocations;
+    if (void* const memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
 BOOST_AUTO_TEST_CASE(january_1st_2010_noon_utc)
 {
     const std::string text{"01 Jan 2010 12:00 +0000"};
@@ -277,3 +311,200 @@ BOOST_AUTO_TEST_CASE(obsolete_military_time_zones)
     BOOST_REQUIRE(validate_time_zone("X", +1100));
     BOOST_REQUIRE(validate_time_zone("Y", +1200));
 }
+
+BOOST_AUTO_TEST_CASE(steady_state_parse_does_not_allocate)
+{
+    std::array<std::byte, 16384> buffer;
+    std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size(),
+        std::pmr::null_memory_resource()};
+    const date_time::parser parser{&arena};
+    const std::string text{"Sat, 9 Jan 2010 12:00:45 -0400 (Starting Date)"};
+    parser.parse(text);
+
+    const auto before = global_allocations;
+    const auto value = parser.parse(text);
+
+    BOOST_REQUIRE_EQUAL(before, global_allocations);
+    BOOST_REQUIRE_EQUAL(date_time::Saturday, value.first.week_day);
+    BOOST_REQUIRE_EQUAL(-400, value.second.time_zone_offset);
+}
+
+BOOST_AUTO_TEST_CASE(rejected_input_does_not_allocate)
+{
+    const date_time::parser parser;
+    const std::string texts[] = {
+        "32 Jan 2010 12:00:45 +0000",
+        "31 Apr 2010 12:00:45 +0000",
+        "Tue, 1 Feb 2008 12:00:45 +0000",
+        "1 Feb 2008 23:59:60 +0000",
+        "9 Jan 2010 12:23:45 +2400",
+        "9 Jan 2010 12:23:45 XYZ"
+    };
+    date_time::moment value;
+    date_time::diagnostic error;
+    parser.try_parse(texts[0], value, error);
+
+    const auto before = global_allocations;
+    for (auto const& text : texts) {
+        BOOST_REQUIRE(!parser.try_parse(text, value, error));
+    }
+
+    BOOST_REQUIRE_EQUAL(before, global_allocations);
+    BOOST_REQUIRE_EQUAL(std::string{"invalid date time"}, error.text);
+}
+
+BOOST_AUTO_TEST_CASE(try_parse_describes_rejected_input)
+{
+    const date_time::parser parser;
+    date_time::moment value;
+    date_time::diagnostic error;
+
+    BOOST_REQUIRE(!parser.try_parse("1 Feb 2008 23:59:60 +0000", value, error));
+    BOOST_REQUIRE_EQUAL(
+        std::string{"leap second only allowed on last day of June or December"},
+        error.text);
+    BOOST_REQUIRE(parser.try_parse("30 Jun 2008 23:59:60 +0000", value, error));
+    BOOST_REQUIRE_EQUAL(60, value.second.second);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_input_does_not_exhaust_memory_resource)
+{
+    std::array<std::byte, 16384> buffer;
+    std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size(),
+        std::pmr::null_memory_resource()};
+    const date_time::parser parser{&arena};
+
+    for (int i = 0; i < 10000; ++i) {
+        BOOST_REQUIRE_THROW(parser.parse("32 Jan 2010 12:00:45 +0000"), std::domain_error);
+        BOOST_REQUIRE_THROW(parser.parse("31 Apr 2010 12:00:45 +0000"), std::domain_error);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(parser_diagnostics_name_offending_value)
+{
+    std::pmr::monotonic_buffer_resource arena;
+    const date_time::parser parser{&arena};
+
+    try {
+        parser.parse("32 Jan 2010 12:00:45 +0000");
+        BOOST_FAIL("expected std::domain_error");
+    } catch (std::domain_error const& error) {
+        BOOST_REQUIRE_EQUAL(std::string{"day 32 out of range 1-31"}, error.what());
+    }
+    try {
+        parser.parse("31 Apr 2010 12:00:45 +0000");
+        BOOST_FAIL("expected std::domain_error");
+    } catch (std::domain_error const& error) {
+        BOOST_REQUIRE_EQUAL(std::string{"day 31 invalid for month"}, error.what());
+    }
+}
+
+static_assert(!std::is_constructible<date_time::parser,
+        std::pmr::memory_resource*, date_time::strictness,
+        date_time::time_zone_table&&>::value,
+    "parser must not keep a reference to a temporary time zone table");
+static_assert(!std::is_constructible<date_time::sequential_parser,
+        std::pmr::memory_resource*, date_time::strictness,
+        date_time::time_zone_table&&>::value,
+    "sequential_parser must not keep a reference to a temporary time zone table");
+
+BOOST_AUTO_TEST_CASE(parser_accepts_added_time_zone)
+{
+    date_time::time_zone_table zones;
+    const date_time::parser parser{std::pmr::get_default_resource(),
+        date_time::Lenient, zones};
+    BOOST_REQUIRE_THROW(parser.parse("9 Jan 2010 12:34:45 JST"), std::domain_error);
+
+    zones.add("JST", +900, false);
+
+    BOOST_REQUIRE_EQUAL(900, parser.parse("9 Jan 2010 12:34:45 JST").second.time_zone_offset);
+}
+
+BOOST_AUTO_TEST_CASE(strict_parser_rejects_time_zone_not_marked_strict)
+{
+    date_time::time_zone_table zones;
+    zones.add("CET", +100, false);
+    zones.add("BST", +100, true);
+    const date_time::parser parser{std::pmr::get_default_resource(),
+        date_time::Strict, zones};
+
+    BOOST_REQUIRE_THROW(parser.parse("9 Jan 2010 12:34:45 CET"), std::domain_error);
+    BOOST_REQUIRE_EQUAL(100, parser.parse("9 Jan 2010 12:34:45 BST").second.time_zone_offset);
+    BOOST_REQUIRE_EQUAL(-500, parser.parse("9 Jan 2010 12:34:45 EST").second.time_zone_offset);
+}
+
+BOOST_AUTO_TEST_CASE(sequential_parser_reuses_date_with_same_prefix)
+{
+    date_time::sequential_parser parser;
+
+    const auto first = parser.parse("Sat, 9 Jan 2010 12:00:45 -0400");
+    const auto second = parser.parse("Sat, 9 Jan 2010 12:01:07 GMT");
+
+    BOOST_REQUIRE_EQUAL(1U, parser.reuses());
+    BOOST_REQUIRE_EQUAL(2U, parser.parses());
+    BOOST_REQUIRE_EQUAL(0.5, parser.reuse_rate());
+    BOOST_REQUIRE_EQUAL(date_time::Saturday, second.first.week_day);
+    BOOST_REQUIRE_EQUAL(9, second.first.day);
+    BOOST_REQUIRE_EQUAL(date_time::January, second.first.month);
+    BOOST_REQUIRE_EQUAL(2010, second.first.year);
+    BOOST_REQUIRE_EQUAL(1, second.second.minute);
+    BOOST_REQUIRE_EQUAL(7, second.second.second);
+    BOOST_REQUIRE_EQUAL(0, second.second.time_zone_offset);
+    BOOST_REQUIRE_EQUAL(-400, first.second.time_zone_offset);
+}
+
+BOOST_AUTO_TEST_CASE(sequential_parser_matches_parse_in_any_order)
+{
+    const std::string texts[] = {
+        "9 Jan 80 12:00:45 -0400",
+        "9 Jan 80 13:00:45 -0400",
+        "9 Jan 801 12:00:45 -0400",
+        "Sat, 9 Jan 2010 12:00:45 -0400",
+        "Sat, 9 Jan 2010 23:59:59 EST",
+        "Sat, 9 Jan 201012:00:45 -0400",
+        "Sun, 10 Jan 2010 12:00:45 -0400",
+        "9 Jan 2010 12:00:45 -0400",
+        "Sat, 9 Jan 2010 (comment) 12:00:45 -0400"
+    };
+    date_time::sequential_parser parser;
+
+    for (auto const& text : texts) {
+        const auto expected = date_time::parse(text);
+        const auto value = parser.parse(text);
+
+        BOOST_REQUIRE_EQUAL(expected.first.week_day, value.first.week_day);
+        BOOST_REQUIRE_EQUAL(expected.first.year, value.first.year);
+        BOOST_REQUIRE_EQUAL(expected.first.month, value.first.month);
+        BOOST_REQUIRE_EQUAL(expected.first.day, value.first.day);
+        BOOST_REQUIRE_EQUAL(expected.second.hour, value.second.hour);
+        BOOST_REQUIRE_EQUAL(expected.second.minute, value.second.minute);
+        BOOST_REQUIRE_EQUAL(expected.second.second, value.second.second);
+        BOOST_REQUIRE_EQUAL(expected.second.time_zone_offset, value.second.time_zone_offset);
+    }
+    BOOST_REQUIRE_EQUAL(2U, parser.reuses());
+}
+
+BOOST_AUTO_TEST_CASE(sequential_parser_validates_time_with_reused_date)
+{
+    date_time::sequential_parser parser;
+    parser.parse("29 Jun 2008 23:59:59 +0000");
+
+    BOOST_REQUIRE_THROW(parser.parse("29 Jun 2008 23:59:60 +0000"), std::domain_error);
+    BOOST_REQUIRE_THROW(parser.parse("29 Jun 2008 24:00:00 +0000"), std::domain_error);
+    BOOST_REQUIRE_THROW(parser.parse("29 Jun 2008 23:00:00 +0000 junk"), std::domain_error);
+    BOOST_REQUIRE_THROW(parser.parse("29 Jun 2008 "), std::domain_error);
+    BOOST_REQUIRE_THROW(parser.parse("30 Feb 2008 23:00:00 +0000"), std::domain_error);
+    BOOST_REQUIRE_EQUAL(30, parser.parse("30 Jun 2008 23:59:60 +0000").first.day);
+}
+
+BOOST_AUTO_TEST_CASE(strict_parser_rejects_military_time_zones)
+{
+    const date_time::parser strict{std::pmr::get_default_resource(),
+        date_time::Strict};
+    const date_time::parser lenient;
+
+    BOOST_REQUIRE_THROW(strict.parse("1 Jan 2010 12:00 Z"), std::domain_error);
+    BOOST_REQUIRE_THROW(strict.parse("1 Jan 2010 12:00 A"), std::domain_error);
+    BOOST_REQUIRE_EQUAL(-100, lenient.parse("1 Jan 2010 12:00 A").second.time_zone_offset);
+    BOOST_REQUIRE_EQUAL(0, strict.parse("1 Jan 2010 12:00 GMT").second.time_zone_offset);
+}
@@ -0,0 +1,146 @@
+// Copyright (C) 2014, Richard Thomson.  All rights reserved.
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+
+#include "time_zone_table.h"
+
+namespace
+{
+
+bool name_less(::date_time::time_zone const& zone, std::string_view name)
+{
+    return std::string_view{zone.name} < name;
+}
+
+bool is_alphabetic(std::string const& name)
+{
+    return !name.empty()
+        && std::all_of(name.begin(), name.end(), [](char c)
+            {
+                return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+            });
+}
+
+void validate(::date_time::time_zone const& zone)
+{
+    if (!is_alphabetic(zone.name)) {
+        throw std::domain_error("time zone name must be alphabetic");
+    }
+    if (zone.offset < -2359 || zone.offset > 2359
+        || std::abs(zone.offset) % 100 > 59) {
+        throw std::domain_error("time zone offset out of range");
+    }
+}
+
+}
+
+namespace date_time
+{
+
+time_zone_table::time_zone_table()
+    : current_{nullptr},
+    epoch_{0},
+    readers_{}
+{
+    // RFC 5322 section 4.3 treats the military zones as obsolete, so only
+    // lenient parsers accept them.
+    std::unique_ptr<snapshot> zones{new snapshot{
+        {"UT", +000, true}, {"GMT", +000, true},
+        {"EST", -500, true}, {"EDT", -400, true},
+        {"CST", -600, true}, {"CDT", -500, true},
+        {"MST", -700, true}, {"MDT", -600, true},
+        {"PST", -800, true}, {"PDT", -700, true},
+        {"A", -100, false}, {"B", -200, false}, {"C", -300, false},
+        {"D", -400, false}, {"E", -500, false}, {"F", -600, false},
+        {"G", -700, false}, {"H", -800, false}, {"I", -900, false},
+        {"K", -1000, false}, {"L", -1100, false}, {"M", -1200, false},
+        {"N", +100, false}, {"O", +200, false}, {"P", +300, false},
+        {"Q", +400, false}, {"R", +500, false}, {"S", +600, false},
+        {"T", +700, false}, {"U", +800, false}, {"V", +900, false},
+        {"W", +1000, false}, {"X", +1100, false}, {"Y", +1200, false},
+        {"Z", +000, false}
+    }};
+    std::sort(zones->begin(), zones->end(),
+        [](time_zone const& lhs, time_zone const& rhs)
+        {
+            return lhs.name < rhs.name;
+        });
+    current_.store(zones.release());
+}
+
+time_zone_table::~time_zone_table()
+{
+    delete current_.load();
+}
+
+void time_zone_table::add(std::string const& name, int offset, bool strict)
+{
+    add(std::vector<time_zone>{time_zone{name, offset, strict}});
+}
+
+void time_zone_table::add(std::vector<time_zone> const& zones)
+{
+    for (auto const& zone : zones) {
+        validate(zone);
+    }
+
+    std::lock_guard<std::mutex> lock{writer_};
+    std::unique_ptr<snapshot> next{new snapshot{*current_.load()}};
+    bool changed = false;
+    for (auto const& zone : zones) {
+        auto const pos = std::lower_bound(next->begin(), next->end(),
+            std::string_view{zone.name}, name_less);
+        if (pos == next->end() || pos->name != zone.name) {
+            next->insert(pos, zone);
+            changed = true;
+        } else if (pos->offset != zone.offset || pos->strict != zone.strict) {
+            pos->offset = zone.offset;
+            pos->strict = zone.strict;
+            changed = true;
+        }
+    }
+    if (changed) {
+        publish(next.release());
+    }
+}
+
+std::optional<time_zone_offset> time_zone_table::find(
+    std::string_view name) const
+{
+    std::atomic<std::size_t>& readers = readers_[epoch_.load() % 2];
+    ++readers;
+    snapshot const& zones = *current_.load();
+    auto const pos = std::lower_bound(zones.begin(), zones.end(), name,
+        name_less);
+    std::optional<time_zone_offset> result;
+    if (pos != zones.end() && pos->name == name) {
+        result = time_zone_offset{pos->offset, pos->strict};
+    }
+    --readers;
+    return result;
+}
+
+// Lookups count themselves in the reader count selected by the epoch.  After
+// swapping in the new snapshot, each count in turn is drained while the
+// epoch steers new lookups to the other, so no lookup can still be reading
+// the previous snapshot when it is deleted.
+void time_zone_table::publish(snapshot const* next)
+{
+    std::unique_ptr<snapshot const> previous{current_.exchange(next)};
+    for (int phase = 0; phase < 2; ++phase) {
+        unsigned const draining = epoch_++ % 2;
+        while (readers_[draining].load() != 0) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+time_zone_table& time_zones()
+{
+    static time_zone_table table;
+    return table;
+}
+
+}
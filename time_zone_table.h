@@ -0,0 +1,65 @@
+// Copyright (C) 2014, Richard Thomson.  All rights reserved.
+#if !defined(TIME_ZONE_TABLE_H)
+#define TIME_ZONE_TABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace date_time
+{
+
+struct time_zone
+{
+    std::string name;
+    int offset;
+    bool strict;
+};
+
+// What find reports about a time zone name.
+struct time_zone_offset
+{
+    int offset;
+    bool strict;
+};
+
+// Time zone abbreviations recognized by the parser, initially the RFC 5322
+// zones with only the military zones disallowed in strict mode.  Lookups never lock; add publishes a new snapshot of the table and
+// frees the old one once no lookup is still reading it.
+class time_zone_table
+{
+public:
+    time_zone_table();
+    ~time_zone_table();
+    time_zone_table(time_zone_table const&) = delete;
+    time_zone_table& operator=(time_zone_table const&) = delete;
+
+    // Adds an abbreviation, or replaces the entry already using that name.
+    void add(std::string const& name, int offset, bool strict);
+    // Adds several abbreviations at once, e.g. on a configuration reload.
+    void add(std::vector<time_zone> const& zones);
+
+    std::optional<time_zone_offset> find(std::string_view name) const;
+
+private:
+    typedef std::vector<time_zone> snapshot;
+
+    void publish(snapshot const* next);
+
+    std::atomic<snapshot const*> current_;
+    mutable std::atomic<unsigned> epoch_;
+    mutable std::atomic<std::size_t> readers_[2];
+    std::mutex writer_;
+};
+
+// The table used by parsers that are not given one.
+time_zone_table& time_zones();
+
+}
+
+#endif
@@ -0,0 +1,117 @@
+// Copyright (C) 2014, Richard Thomson.  All rights reserved.
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "time_zone_table.h"
+
+BOOST_AUTO_TEST_SUITE(time_zone_table_suite);
+
+BOOST_AUTO_TEST_CASE(contains_rfc_zones)
+{
+    const date_time::time_zone_table zones;
+
+    const auto zone = zones.find("EDT");
+
+    BOOST_REQUIRE(zone);
+    BOOST_REQUIRE_EQUAL(-400, zone->offset);
+    BOOST_REQUIRE(zone->strict);
+    BOOST_REQUIRE(zones.find("Z"));
+    BOOST_REQUIRE(!zones.find("Z")->strict);
+}
+
+BOOST_AUTO_TEST_CASE(unknown_name_is_not_found)
+{
+    const date_time::time_zone_table zones;
+
+    BOOST_REQUIRE(!zones.find("CET"));
+    BOOST_REQUIRE(!zones.find(""));
+    BOOST_REQUIRE(!zones.find("gmt"));
+}
+
+BOOST_AUTO_TEST_CASE(added_zone_is_found)
+{
+    date_time::time_zone_table zones;
+
+    zones.add("CET", +100, false);
+
+    const auto zone = zones.find("CET");
+    BOOST_REQUIRE(zone);
+    BOOST_REQUIRE_EQUAL(100, zone->offset);
+    BOOST_REQUIRE(!zone->strict);
+    BOOST_REQUIRE(zones.find("GMT"));
+}
+
+BOOST_AUTO_TEST_CASE(add_replaces_existing_zone)
+{
+    date_time::time_zone_table zones;
+    zones.add("IST", +530, false);
+
+    zones.add("IST", +100, true);
+
+    const auto zone = zones.find("IST");
+    BOOST_REQUIRE_EQUAL(100, zone->offset);
+    BOOST_REQUIRE(zone->strict);
+}
+
+BOOST_AUTO_TEST_CASE(adds_several_zones_at_once)
+{
+    date_time::time_zone_table zones;
+
+    zones.add({{"CET", +100, false}, {"JST", +900, false}, {"GMT", +000, true}});
+
+    BOOST_REQUIRE_EQUAL(100, zones.find("CET")->offset);
+    BOOST_REQUIRE_EQUAL(900, zones.find("JST")->offset);
+    BOOST_REQUIRE_EQUAL(0, zones.find("GMT")->offset);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_zone_in_batch_adds_nothing)
+{
+    date_time::time_zone_table zones;
+
+    BOOST_REQUIRE_THROW(zones.add({{"CET", +100, false}, {"X1", 0, false}}),
+        std::domain_error);
+    BOOST_REQUIRE(!zones.find("CET"));
+}
+
+BOOST_AUTO_TEST_CASE(invalid_zones_are_rejected)
+{
+    date_time::time_zone_table zones;
+
+    BOOST_REQUIRE_THROW(zones.add("", 0, false), std::domain_error);
+    BOOST_REQUIRE_THROW(zones.add("UTC+1", 100, false), std::domain_error);
+    BOOST_REQUIRE_THROW(zones.add("XYZ", 2400, false), std::domain_error);
+    BOOST_REQUIRE_THROW(zones.add("XYZ", -60, false), std::domain_error);
+    BOOST_REQUIRE_THROW(zones.add("XYZ", std::numeric_limits<int>::min(), false),
+        std::domain_error);
+}
+
+BOOST_AUTO_TEST_CASE(readers_see_consistent_table_while_zones_are_added)
+{
+    date_time::time_zone_table zones;
+    std::atomic<bool> done{false};
+    bool consistent = true;
+
+    std::thread reader{[&]
+        {
+            while (!done) {
+                const auto zone = zones.find("GMT");
+                consistent = consistent && zone && zone->offset == 0;
+            }
+        }};
+    for (int i = 0; i < 10000; ++i) {
+        zones.add("XYZ", i % 2 == 0 ? +100 : -100, false);
+    }
+    done = true;
+    reader.join();
+
+    BOOST_REQUIRE(consistent);
+    BOOST_REQUIRE_EQUAL(-100, zones.find("XYZ")->offset);
+}
+
+BOOST_AUTO_TEST_SUITE_END();